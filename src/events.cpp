@@ -56,6 +56,13 @@ int handle_events() {
                         globals::player.velMult = 2.0;
                         break;
 
+                    case SDL_SCANCODE_I:
+                        GameRenderer::toggleInterlace();
+                        break;
+                    case SDL_SCANCODE_M:
+                        GameRenderer::toggleInterlaceMetric();
+                        break;
+
                     default:
                         break;
                 }
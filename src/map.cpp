@@ -1,6 +1,7 @@
 #include "map.hpp"
 
 #include <fstream>
+#include <cstdio>
 
 Map::Map(int w, int h) {
     init(w, h);
@@ -12,13 +13,18 @@ Map::Map(int w, int h) {
     }
 }
 
+// the map is surrounded by a one tile wide border of solid sentinel walls, so that
+// tiles[-1..width][-1..height] is always valid and ray casts never need bound checks
 void Map::init(int w, int h) {
     width = w;
     height = h;
 
-    tiles = new char*[width];
-    for (int x = 0; x < width; x++)
-        tiles[x] = new char[height];
+    tiles = new char*[width + 2] + 1;
+    for (int x = -1; x <= width; x++) {
+        tiles[x] = new char[height + 2] + 1;
+        for (int y = -1; y <= height; y++)
+            tiles[x][y] = (x < 0 || x >= width || y < 0 || y >= height) ? SENTINEL_TILE : 0;
+    }
 }
 
 Map::Map(std::string filename) {
@@ -35,6 +41,7 @@ void Map::readMap(std::string filename) {
         file >> line;
         parseLine(line, l);
     }
+    parseTextures(file);
 
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
@@ -44,22 +51,50 @@ void Map::readMap(std::string filename) {
     }
 }
 
+// returns -1 if hex isn't a (lowercase) hex digit
+static int parseHex(int hex) {
+    if (hex >= '0' && hex <= '9') return hex - '0';
+    if (hex >= 'a' && hex <= 'f') return 10 + hex - 'a';
+    return -1;
+}
+
 void Map::parseLine(std::string line, int y) {
-    for (int x = 0; x < width; x++) {
-        int hex = line.at(x);
-        hex = hex >= 'a' ? 10 + hex - 'a' : hex - '0';
-        tiles[x][y] = hex;
+    for (int x = 0; x < width; x++)
+        tiles[x][y] = parseHex(line.at(x));
+}
+
+// optional lines following the tiles:
+//   tex <tile> <N/S texture> <E/W texture>
+//   floor <texture>
+void Map::parseTextures(std::istream& file) {
+    std::string key;
+    while (file >> key) {
+        if (key == "tex") {
+            std::string tile, ns, ew;
+            file >> tile >> ns >> ew;
+            int t = tile.size() == 1 ? parseHex(tile[0]) : -1;
+            if (t <= 0) {
+                fprintf(stderr, "Invalid tile '%s' in texture definition, ignoring it\n", tile.c_str());
+                continue;
+            }
+            wallTextures[t][0] = ns;
+            wallTextures[t][1] = ew;
+        } else if (key == "floor") {
+            file >> floorTexture;
+        } else {
+            break;
+        }
     }
 }
 
 Map::~Map() {
     if (tiles) {
-        for (int x = 0; x < width; x++) {
+        for (int x = -1; x <= width; x++) {
             if (tiles[x])
-                delete[] tiles[x];
+                delete[] (tiles[x] - 1);
         }
 
-        delete[] tiles;
+        delete[] (tiles - 1);
     }
 }
 
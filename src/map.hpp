@@ -1,12 +1,18 @@
 #pragma once
 
 #include <string>
+#include <istream>
+
+#define SENTINEL_TILE 1
 
 class Map {
     public:
         int width, height;
         int playerStartX, playerStartY;
         char** tiles;
+        // optional texture names per tile (N/S, E/W faces) and for the floor, empty if unset
+        std::string wallTextures[16][2];
+        std::string floorTexture;
 
         Map(int w, int h);
         Map(std::string filename);
@@ -17,5 +23,6 @@ class Map {
     private:
         void init(int w, int h);
         void parseLine(std::string line, int y);
+        void parseTextures(std::istream& file);
         void readMap(std::string filename);
 };
\ No newline at end of file
@@ -1,8 +1,7 @@
 #include <cmath>
 constexpr double _2pi = 2*M_PI;
-constexpr double _3pi4 = M_PI + M_PI_2;
 #include <vector>
-#include <filesystem>
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <pthread.h>
@@ -12,16 +11,23 @@ constexpr double _3pi4 = M_PI + M_PI_2;
 #include <SDL2pp/Point.hh>
 
 #include "render.hpp"
+#include "textures.hpp"
 #include "globals.hpp"
 #include "player.hpp"
 
 namespace GameRenderer {
     enum wall { N, S, E, W };
+    typedef struct vec2 {
+        double x, y;
+    } vec2;
     typedef struct ray_ret {
+        // perpendicular distance to the camera plane, no fisheye correction required
         double rayDist;
         wall wallDir;
         uint8_t textureId;
         uint8_t texturePos;
+        // map position of the hit, used to reproject the ray in interlaced mode
+        double hitX, hitY;
     } ray;
     typedef struct floor_ray_ret {
         double intersectX;
@@ -42,15 +48,44 @@ namespace GameRenderer {
     
     std::vector<double> rayAngles;
     std::vector<double> rayAnglesVert;
+    std::vector<vec2> rayDirs;
+
+    // results of the wall pass, the floor pass only shades what lies below each wall
+    std::vector<ray> wallRays;
+    std::vector<int> wallHeights;
+    std::vector<int> floorStart;
+    int floorStartMin;
+
+    // interlaced mode: only the columns/floor pixels matching the frame parity are rendered,
+    // the others are reprojected from the previous frame (walls) or reused/duplicated (floor)
+    bool interlaced = false, interlaceMetric = false;
+    bool historyValid = false, updateHistory = true;
+    bool frameReconstructed = false;
+    int frameParity = 0, skippedCols = 0, reprojectedCols = 0;
+    // -1 renders the full floor; floorStatic keeps the missing pixels from the previous frame
+    int floorParity = -1;
+    bool floorStatic = false;
+    double prevPosX, prevPosY, prevAngle;
+    std::vector<ray> prevWallRays, reprojRays;
+    std::vector<Uint32> floorBackup, metricRef, metricTest;
+    double metricAbsSum[3] = {}, metricSqSum = 0;
+    int metricFrames = 0, metricFallbacks = 0;
+    long metricSkipped = 0, metricReprojected = 0;
+    void resetMetric();
+    void reprojectWalls(double fwdX, double fwdY);
+    bool reprojectionFits(int x);
+    void measureInterlace();
     void fillRayAngles();
-    void loadTextures();
+    void resolveTextureIds();
     void drawStatusBar();
     void drawPlayer();
     void drawMap();
+    vec2 columnDir(int x, double fwdX, double fwdY);
+    void castWalls();
     void drawFloor();
     void drawWall(int x, int height, char texturePos, char texture);
     void drawScreen();
-    ray castRay(const double posX, const double posY, double angle);
+    ray castRay(const double posX, const double posY, const vec2 dir);
     floor_ray castFloorRay(const double posX, const double posY, double angleH, double angleV);
 
     bool shall_exit = false;
@@ -75,7 +110,8 @@ namespace GameRenderer {
     void init(SDL2pp::Renderer& renderer) {
         if (firstRun) {
             mainRenderer = &renderer;
-            loadTextures();
+            Textures::init(renderer);
+            resolveTextureIds();
         }
 
         SDL2pp::Point p = mainRenderer->GetOutputSize();
@@ -108,61 +144,159 @@ namespace GameRenderer {
         pthread_barrier_wait(&renderStart);
         pthread_barrier_wait(&renderDone);
         delete[] floorPixels;
+        Textures::destroy();
     }
 
     // the angles between each scanlines/columns aren't consistent, so these are pre-calculated
     void fillRayAngles() {
-        rayAngles.clear();
-        rayAngles.reserve(colCount);
+        rayAngles.resize(colCount);
+        rayDirs.resize(colCount);
         for (int i = 0; i < colCount; i++) {
             double l = -(colCount / 2) + 0.5 + i;
             rayAngles[i] = fmod(atan(l / projplaneDist) + _2pi, _2pi);
+
+            // camera space: x points right, y points forward (unit length)
+            rayDirs[i] = { l / projplaneDist, 1 };
         }
 
-        rayAnglesVert.clear();
-        rayAnglesVert.reserve(colHeight/2);
+        wallRays.resize(colCount);
+        wallHeights.resize(colCount);
+        floorStart.resize(colCount);
+        reprojRays.resize(colCount);
+        historyValid = false;
+
+        rayAnglesVert.resize(colHeight/2);
         for (int i = 0; i < colHeight/2; i++) {
             double h = 0.5 + i;
             rayAnglesVert[i] = fmod(atan(h / projplaneDist) + _2pi, _2pi);
         }
     }
 
-    std::vector<std::string> texPaths;
-    std::vector<SDL2pp::Texture> textures;
-    std::vector<SDL2pp::Surface> texturesPix;
-    void loadTextures() {
-        namespace fs = std::filesystem;
-        std::string texBasePath = "./textures";
-
-        for (const auto entry : fs::directory_iterator(texBasePath))
-            if (entry.is_regular_file())
-                texPaths.push_back(entry.path().string());
+    // texture ids per map tile (N/S, E/W faces) and for the floor
+    uint8_t wallTextureIds[16][2];
+    int floorTextureId;
+    int resolveTexture(const std::string& name, int legacyId) {
+        // maps without texture names use the sorted texture order
+        int id = name.empty() ? legacyId : Textures::find(name);
+        if (id < 0 || id >= Textures::count()) {
+            std::cerr << "Unknown texture " << (name.empty() ? std::to_string(legacyId) : name) << std::endl;
+            id = 0;
+        }
 
-        std::sort(texPaths.begin(), texPaths.end());
+        return id;
+    }
 
-        for (const auto path : texPaths) {
-            textures.push_back(SDL2pp::Texture{*mainRenderer, path});
-            texturesPix.push_back(SDL2pp::Surface{path});
-        }
+    void resolveTextureIds() {
+        using namespace globals;
+        // only tiles that appear on the map (or as its border) need a texture
+        bool used[16] = {};
+        used[SENTINEL_TILE] = true;
+        for (int x = 0; x < map.width; x++)
+            for (int y = 0; y < map.height; y++)
+                used[map.tiles[x][y] & 0xf] = true;
+
+        for (int t = 1; t < 16; t++)
+            for (int face = 0; face < 2; face++)
+                wallTextureIds[t][face] = used[t] ? resolveTexture(map.wallTextures[t][face], (t-1)*2 + face) : 0;
+
+        floorTextureId = resolveTexture(map.floorTexture, LEGACY_FLOOR_TEXTURE_ID);
     }
 
     void resize() { resized = true; }
 
+    void toggleInterlace() {
+        interlaced = !interlaced;
+        historyValid = false;
+        std::cout << "Interlaced rendering " << (interlaced ? "on" : "off") << std::endl;
+    }
+
+    void resetMetric() {
+        std::fill(metricAbsSum, metricAbsSum + 3, 0);
+        metricSqSum = 0;
+        metricFrames = metricFallbacks = 0;
+        metricSkipped = metricReprojected = 0;
+    }
+
+    void toggleInterlaceMetric() {
+        interlaceMetric = !interlaceMetric;
+        resetMetric();
+        std::cout << "Interlace metric " << (interlaceMetric ? "on" : "off") << std::endl;
+    }
+
     void render() {
         if (resized) {
             init(*mainRenderer);
             resized = false;
         }
+        Textures::poll();
+
+        if (interlaced && interlaceMetric)
+            measureInterlace();
 
-        mainRenderer->SetDrawColor(0, 0, 0);
+        // the ceiling is flat, so clearing the screen takes care of it
+        mainRenderer->SetDrawColor(20, 20, 20);
         mainRenderer->Clear();
 
         drawScreen();
+
+        if (interlaced && interlaceMetric) {
+            // compare against the full frame rendered by measureInterlace; frames that fell
+            // back to full rendering are only counted, as they'd dilute the error
+            if (frameReconstructed) {
+                mainRenderer->ReadPixels(SDL_Rect{0, 0, colCount, colHeight}, SDL_PIXELFORMAT_ABGR8888, metricTest.data(), 4*colCount);
+                for (size_t i = 0; i < metricTest.size(); i++) {
+                    for (int c = 0; c < 3; c++) {
+                        const int d = (int)((metricTest[i] >> 8*c) & 0xff) - (int)((metricRef[i] >> 8*c) & 0xff);
+                        metricAbsSum[c] += abs(d);
+                        metricSqSum += d * d;
+                    }
+                }
+                metricFrames++;
+                metricSkipped += skippedCols;
+                metricReprojected += reprojectedCols;
+            } else {
+                metricFallbacks++;
+            }
+
+            if (metricFrames + metricFallbacks == INTERLACE_METRIC_FRAMES) {
+                if (metricFrames) {
+                    const double samples = (double)metricTest.size() * metricFrames,
+                                 mse = metricSqSum / (3 * samples);
+                    std::cout << "Interlace diff over " << metricFrames << " interlaced frames: mean abs error"
+                              << " R " << metricAbsSum[0] / samples << ", G " << metricAbsSum[1] / samples
+                              << ", B " << metricAbsSum[2] / samples
+                              << ", PSNR " << (mse > 0 ? 10 * log10(255 * 255 / mse) : INFINITY) << " dB, "
+                              << 100.0 * metricReprojected / std::max(metricSkipped, 1L) << "% of skipped columns reprojected, "
+                              << metricFallbacks << " full frame fallbacks" << std::endl;
+                } else {
+                    std::cout << "Interlace diff: all " << metricFallbacks << " frames fell back to full rendering" << std::endl;
+                }
+                resetMetric();
+            }
+        }
+
         drawStatusBar();
 
         mainRenderer->Present();
     }
 
+    // renders a full reference frame without touching the state the interlaced frame is built from
+    void measureInterlace() {
+        const size_t viewSize = colCount * colHeight;
+        metricRef.resize(viewSize);
+        metricTest.resize(viewSize);
+        floorBackup.assign(floorPixels, floorPixels + colCount * (colHeight/2));
+
+        interlaced = false, updateHistory = false;
+        mainRenderer->SetDrawColor(20, 20, 20);
+        mainRenderer->Clear();
+        drawScreen();
+        mainRenderer->ReadPixels(SDL_Rect{0, 0, colCount, colHeight}, SDL_PIXELFORMAT_ABGR8888, metricRef.data(), 4*colCount);
+        interlaced = true, updateHistory = true;
+
+        std::copy(floorBackup.begin(), floorBackup.end(), floorPixels);
+    }
+
     void drawStatusBar() {
         mainRenderer->SetDrawColor(SDL_Color{0, 0, 0});
         mainRenderer->FillRect(SDL_Rect{0, colHeight, colCount, 100});
@@ -214,12 +348,12 @@ namespace GameRenderer {
 
     void drawFloorPart(uintptr_t threadnum) {
         using namespace globals;
-        Uint32* floorTexturePixels = (Uint32*)texturesPix[14].Get()->pixels;
+        Uint32* floorTexturePixels = Textures::pixels(floorTextureId);
 
+        // lines are interleaved between threads, as the lines closest to the horizon
+        // are the most likely to be hidden behind walls
         const int surfHeight = floorSurf.GetHeight();
-        const int startLine = (surfHeight / RENDER_THREAD_COUNT) * threadnum,
-                  endLine = startLine + (surfHeight / RENDER_THREAD_COUNT);
-        for (int line = startLine; line < endLine; line++) {
+        for (int line = floorStartMin + threadnum; line < surfHeight; line += RENDER_THREAD_COUNT) {
             // cast two rays for the left- and rightmost pixels
             const floor_ray r1 = castFloorRay(player.posX, player.posY,
                 player.angle + rayAngles[0], rayAnglesVert[line]),
@@ -230,26 +364,49 @@ namespace GameRenderer {
             const double stepX = (r2.intersectX - r1.intersectX) / colCount,
                          stepY = (r2.intersectY - r1.intersectY) / colCount;
 
-            // fill the entire line
-            double floorPosX = r1.intersectX, floorPosY = r1.intersectY;
-            for (int col = 0; col < colCount; col++) {
-                uint8_t textureX = (int)(floorPosX * TEXTURE_RES) % TEXTURE_RES,
-                        textureY = (int)(floorPosY * TEXTURE_RES) % TEXTURE_RES;
-                if (textureX < 0) textureX += 64;
-                if (textureY < 0) textureY += 64;
-                
-                // TODO: account for different pixel formats and texture sizes
-                Uint32 color = floorTexturePixels[64*textureY + textureX];
-                floorPixels[line*colCount + col] = color;
-                floorPosX += stepX, floorPosY += stepY;
+            // fill each run of columns in which the floor is visible on this line
+            int col = 0;
+            while (col < colCount) {
+                while (col < colCount && floorStart[col] > line) col++;
+                int runEnd = col;
+                while (runEnd < colCount && floorStart[runEnd] <= line) runEnd++;
+                if (col == runEnd) break;
+
+                // in interlaced mode, only every other pixel is shaded (checkerboard)
+                int shadeStart = col, stride = 1;
+                if (floorParity >= 0 && runEnd - col > 1) {
+                    shadeStart = col + ((col + line + floorParity) & 1);
+                    stride = 2;
+                }
+
+                double floorPosX = r1.intersectX + stepX * shadeStart,
+                       floorPosY = r1.intersectY + stepY * shadeStart;
+                for (int c = shadeStart; c < runEnd; c += stride) {
+                    uint8_t textureX = (int)(floorPosX * TEXTURE_RES) % TEXTURE_RES,
+                            textureY = (int)(floorPosY * TEXTURE_RES) % TEXTURE_RES;
+                    if (textureX < 0) textureX += 64;
+                    if (textureY < 0) textureY += 64;
+
+                    // TODO: account for different pixel formats and texture sizes
+                    Uint32 color = floorTexturePixels[64*textureY + textureX];
+                    floorPixels[line*colCount + c] = color;
+                    floorPosX += stepX * stride, floorPosY += stepY * stride;
+                }
+
+                // reprojecting a floor pixel costs as much as shading it, so unless the camera
+                // stood still, the skipped pixels are copied from their shaded neighbours instead
+                if (stride == 2 && !floorStatic) {
+                    Uint32* linePixels = floorPixels + line*colCount;
+                    for (int c = shadeStart == col ? col + 1 : col; c < runEnd; c += 2)
+                        linePixels[c] = linePixels[c > col ? c - 1 : c + 1];
+                }
+
+                col = runEnd;
             }
         }
     }
 
     void drawFloor() {
-        using namespace globals;
-        Uint32* floorTexturePixels = (Uint32*)texturesPix[14].Get()->pixels;
-
         const int surfHeight = floorSurf.GetHeight();
         pthread_barrier_wait(&renderStart);
         pthread_barrier_wait(&renderDone);
@@ -259,111 +416,187 @@ namespace GameRenderer {
     }
 
     void drawWall(int x, int h, char texturePos, char textureId) {
-        mainRenderer->Copy(textures[textureId], SDL_Rect{texturePos, 0, 1, 64}, SDL_Rect{x, (colHeight - h) / 2, 1, h});
+        mainRenderer->Copy(Textures::get(textureId), SDL_Rect{texturePos, 0, 1, 64}, SDL_Rect{x, (colHeight - h) / 2, 1, h});
     }
 
-    void drawScreen() {
-        mainRenderer->SetDrawColor(SDL_Color{20, 20, 20});
-        mainRenderer->FillRect(SDL_Rect{0, 0, colCount, colHeight/2});
-        mainRenderer->SetDrawColor(SDL_Color{40, 40, 40});
-        mainRenderer->FillRect(SDL_Rect{0, colHeight/2, colCount, colHeight/2});
+    // rotates the camera space direction of column x into map space
+    vec2 columnDir(int x, double fwdX, double fwdY) {
+        return {
+            fwdX * rayDirs[x].y - fwdY * rayDirs[x].x,
+            fwdY * rayDirs[x].y + fwdX * rayDirs[x].x
+        };
+    }
 
-        drawFloor();
-        for (int x = 0; x < colCount; x++) {
-            using namespace globals;
-            const double rayAngle = player.angle + rayAngles[x];
-            ray r = castRay(player.posX, player.posY, rayAngle);
-            int wallHeight = projplaneDist / r.rayDist / cos(rayAngles[x]);
-            drawWall(x, wallHeight, r.texturePos, r.textureId + (r.wallDir >= E));
+    // projects the previous frame's hits into the current camera; each skipped column
+    // gets the nearest hit that lands on it
+    void reprojectWalls(double fwdX, double fwdY) {
+        using namespace globals;
+        for (int x = 0; x < colCount; x++)
+            reprojRays[x].rayDist = 1e30;
+
+        for (const ray& r : prevWallRays) {
+            const double vx = r.hitX - player.posX, vy = r.hitY - player.posY,
+                         depth = vx * fwdX + vy * fwdY;
+            if (depth <= 0.01) continue;
+
+            // camera right is (-fwdY, fwdX)
+            const int x = lround((fwdX * vy - fwdY * vx) / depth * projplaneDist + colCount / 2 - 0.5);
+            if (x < 0 || x >= colCount || !((x + frameParity) & 1) || depth >= reprojRays[x].rayDist)
+                continue;
+
+            reprojRays[x] = r;
+            reprojRays[x].rayDist = depth;
         }
     }
 
-    // returns distance to the nearest wall
-    ray castRay(const double posX, const double posY, double angle) {
-        while (angle > _2pi) angle -= _2pi;
-
-        double rayStepX, rayStepY,
-               rayPosFinalX1, rayPosFinalY1,
-               rayPosFinalX2, rayPosFinalY2;
-
-        // find horizontal walls
-        double rayDistHoriz = INFINITY;
-        if (angle != M_PI_2 && angle != _3pi4) {
-            rayStepY = (angle < M_PI_2 || angle > _3pi4) ? -1 : 1;
-            rayStepX = -rayStepY * tan(angle);
-            
-            double stepInitialY = rayStepY < 0 ? -(posY - (int)posY) : 1 - (posY - (int)posY),
-                   stepInitialX = rayStepX * stepInitialY / rayStepY;
-            double rayPosX = posX + stepInitialX, rayPosY = posY + stepInitialY;
-
-            const int mapPosOffsetY = rayStepY <= 0 ? -1 : 0;
-
-            while ((int)rayPosX >= 0 && (int)rayPosX < globals::map.width
-                && (int)rayPosY + mapPosOffsetY >= 0 && (int)rayPosY + mapPosOffsetY < globals::map.height
-                && !globals::map.tiles
-                    [(int)rayPosX]
-                    [(int)rayPosY + mapPosOffsetY]) {
-                rayPosX += rayStepX,
-                rayPosY += rayStepY;
-            }
-            const double rayDistHorizX = rayPosX - posX,
-                         rayDistHorizY = rayPosY - posY;
-            rayDistHoriz = sqrt(rayDistHorizX*rayDistHorizX + rayDistHorizY*rayDistHorizY);
-            rayPosFinalX1 = rayPosX;
-            rayPosFinalY1 = rayPosY;
+    // a reprojected hit is only used if it continues the wall face of a freshly cast
+    // neighbour at a plausible depth, anything else (disocclusions, gaps) is cast
+    bool reprojectionFits(int x) {
+        const ray& r = reprojRays[x];
+        double minDist = 1e30, maxDist = 0;
+        bool sameFace = false;
+        for (int n = x - 1; n <= x + 1; n += 2) {
+            if (n < 0 || n >= colCount) continue;
+            sameFace |= wallRays[n].wallDir == r.wallDir && wallRays[n].textureId == r.textureId;
+            minDist = std::min(minDist, wallRays[n].rayDist);
+            maxDist = std::max(maxDist, wallRays[n].rayDist);
         }
 
-        // find vertical walls
-        double rayDistVert = INFINITY;
-        if (angle != 0 && angle != M_PI) {
-            rayStepX = (angle < M_PI) ? 1 : -1;
-            rayStepY = -rayStepX / tan(angle);
-            
-            double stepInitialX = rayStepX < 0 ? -(posX - (int)posX) : 1 - (posX - (int)posX),
-                   stepInitialY = rayStepY * stepInitialX / rayStepX;
-            double rayPosX = posX + stepInitialX, rayPosY = posY + stepInitialY;
-
-            const int mapPosOffsetX = rayStepX <= 0 ? -1 : 0;
-
-            while ((int)rayPosX + mapPosOffsetX >= 0 && (int)rayPosX + mapPosOffsetX < globals::map.width
-                && (int)rayPosY >= 0 && (int)rayPosY < globals::map.height
-                && !globals::map.tiles
-                    [(int)rayPosX + mapPosOffsetX]
-                    [(int)rayPosY]) {
-                rayPosX += rayStepX,
-                rayPosY += rayStepY;
+        return sameFace
+            && r.rayDist >= minDist * (1 - INTERLACE_DEPTH_TOLERANCE)
+            && r.rayDist <= maxDist * (1 + INTERLACE_DEPTH_TOLERANCE);
+    }
+
+    void castWalls() {
+        using namespace globals;
+        const int surfHeight = floorSurf.GetHeight();
+        floorStartMin = surfHeight;
+
+        // fall back to a full frame if there is nothing (close enough) to reconstruct from
+        const double moved = hypot(player.posX - prevPosX, player.posY - prevPosY),
+                     turned = remainder(player.angle - prevAngle, _2pi);
+        const bool reconstruct = interlaced && historyValid
+            && moved <= INTERLACE_MAX_MOVE && fabs(turned) <= INTERLACE_MAX_TURN;
+        frameReconstructed = reconstruct;
+        floorParity = reconstruct ? frameParity : -1;
+        floorStatic = moved == 0 && turned == 0;
+
+        // cast the columns of this frame's parity first, the skipped ones are checked against them
+        const double fwdX = sin(player.angle), fwdY = -cos(player.angle);
+        for (int x = 0; x < colCount; x++)
+            if (!reconstruct || !((x + frameParity) & 1))
+                wallRays[x] = castRay(player.posX, player.posY, columnDir(x, fwdX, fwdY));
+
+        skippedCols = reprojectedCols = 0;
+        if (reconstruct) {
+            reprojectWalls(fwdX, fwdY);
+            for (int x = !frameParity; x < colCount; x += 2) {
+                skippedCols++;
+                if (reprojectionFits(x)) {
+                    wallRays[x] = reprojRays[x];
+                    reprojectedCols++;
+                } else {
+                    wallRays[x] = castRay(player.posX, player.posY, columnDir(x, fwdX, fwdY));
+                }
             }
-            const double rayDistVertX = rayPosX - posX,
-                         rayDistVertY = rayPosY - posY;
-            rayDistVert = sqrt(pow(rayDistVertX, 2) + pow(rayDistVertY, 2));
-            rayPosFinalX2 = rayPosX;
-            rayPosFinalY2 = rayPosY;
         }
 
-        double rDist;
-        wall wDir;
-        uint8_t tId = 0;
-        uint8_t tPos;
-        if (rayDistHoriz < rayDistVert) {
-            rDist = rayDistHoriz;
-            wDir = rayStepY < 0 ? N : S;
-            tId = globals::map.tiles[(int)rayPosFinalX1][(int)rayPosFinalY1 - ((angle < M_PI_2 || angle >= _3pi4) ? 1 : 0)];
-            tPos = (int)(rayPosFinalX1 * TEXTURE_RES) % TEXTURE_RES;
-            if (wDir == S) tPos = TEXTURE_RES - tPos - 1;
+        for (int x = 0; x < colCount; x++) {
+            wallHeights[x] = projplaneDist / wallRays[x].rayDist;
+
+            // first floor line below the bottom of the wall
+            const int wallBottom = (colHeight - wallHeights[x]) / 2 + wallHeights[x];
+            floorStart[x] = std::clamp(wallBottom - surfHeight, 0, surfHeight);
+            floorStartMin = std::min(floorStartMin, floorStart[x]);
+        }
+    }
+
+    void drawScreen() {
+        // the floor is copied as a whole, so walls are drawn over it, but it is only
+        // shaded where it's actually visible
+        castWalls();
+        drawFloor();
+
+        for (int x = 0; x < colCount; x++)
+            drawWall(x, wallHeights[x], wallRays[x].texturePos, wallRays[x].textureId);
+
+        // the history is only needed by interlaced mode; toggling it clears historyValid
+        if (interlaced && updateHistory) {
+            using namespace globals;
+            prevWallRays = wallRays;
+            prevPosX = player.posX, prevPosY = player.posY, prevAngle = player.angle;
+            historyValid = true;
+            frameParity ^= 1;
+        }
+    }
+
+    // single pass grid DDA, specialized on the step direction along each axis;
+    // relies on the map's sentinel border to terminate instead of bound checks
+    template <int stepX, int stepY>
+    ray castRayDir(const double posX, const double posY, const vec2 dir) {
+        // a zero component never crosses a grid line on that axis
+        const double deltaX = dir.x != 0 ? stepX / dir.x : 1e30,
+                     deltaY = dir.y != 0 ? stepY / dir.y : 1e30;
+
+        int mapX = (int)posX, mapY = (int)posY;
+        double sideX = (stepX > 0 ? mapX + 1 - posX : posX - mapX) * deltaX,
+               sideY = (stepY > 0 ? mapY + 1 - posY : posY - mapY) * deltaY;
+
+        bool vertical;
+        do {
+            vertical = sideX < sideY;
+            if (vertical) {
+                sideX += deltaX;
+                mapX += stepX;
+            } else {
+                sideY += deltaY;
+                mapY += stepY;
+            }
+        } while (!globals::map.tiles[mapX][mapY]);
+
+        const uint8_t tId = globals::map.tiles[mapX][mapY] & 0xf;
+        if (vertical) {
+            const double rDist = sideX - deltaX,
+                         hitX = posX + rDist * dir.x,
+                         hitY = posY + rDist * dir.y;
+            uint8_t tPos = (int)((hitY - floor(hitY)) * TEXTURE_RES);
+            if (stepX < 0) tPos = TEXTURE_RES - tPos - 1;
+
+            return {
+                .rayDist = rDist,
+                .wallDir = stepX < 0 ? W : E,
+                .textureId = wallTextureIds[tId][1],
+                .texturePos = tPos,
+                .hitX = hitX,
+                .hitY = hitY
+            };
         } else {
-            rDist = rayDistVert;
-            wDir = rayStepX < 0 ? W : E;
-            tId = globals::map.tiles[(int)rayPosFinalX2 - (angle >= M_PI ? 1 : 0)][(int)rayPosFinalY2];
-            tPos = (int)(rayPosFinalY2 * TEXTURE_RES) % TEXTURE_RES;
-            if (wDir == W) tPos = TEXTURE_RES - tPos - 1;
+            const double rDist = sideY - deltaY,
+                         hitX = posX + rDist * dir.x,
+                         hitY = posY + rDist * dir.y;
+            uint8_t tPos = (int)((hitX - floor(hitX)) * TEXTURE_RES);
+            if (stepY > 0) tPos = TEXTURE_RES - tPos - 1;
+
+            return {
+                .rayDist = rDist,
+                .wallDir = stepY < 0 ? N : S,
+                .textureId = wallTextureIds[tId][0],
+                .texturePos = tPos,
+                .hitX = hitX,
+                .hitY = hitY
+            };
         }
-        
-        return {
-            .rayDist = rDist,
-            .wallDir = wDir,
-            .textureId = (unsigned char)((tId-1)*2),
-            .texturePos = tPos
+    }
+
+    // returns distance to the nearest wall along dir (not normalized)
+    ray castRay(const double posX, const double posY, const vec2 dir) {
+        typedef ray (*cast_fn)(const double, const double, const vec2);
+        static constexpr cast_fn casters[4] = {
+            castRayDir< 1,  1>, castRayDir<-1,  1>,
+            castRayDir< 1, -1>, castRayDir<-1, -1>
         };
+
+        return casters[(dir.x < 0) | ((dir.y < 0) << 1)](posX, posY, dir);
     }
 
     floor_ray castFloorRay(const double posX, const double posY, double angleH, double angleV) {
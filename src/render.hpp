@@ -8,13 +8,34 @@
 #define MAP_POS_Y colHeight
 
 #define TEXTURE_RES 64
+// floor texture for maps that don't name one, index into the sorted texture directory
+#define LEGACY_FLOOR_TEXTURE_ID 14
 #ifndef RENDER_THEAD_COUNT
 #define RENDER_THREAD_COUNT 1
 #endif
 
+// interlaced mode falls back to a full frame if the camera moved/turned further than this since
+// the last frame. Per frame, walking covers PLAYER_VELOCITY_BASE / fps (0.1 at 60 fps, 0.2 at 30)
+// and turning PLAYER_ANGVEL_BASE / fps (~0.04 rad at 60 fps), both doubled while sprinting, so these
+// keep the mode active for sprinting down to ~25 fps. Reprojected wall columns are validated against
+// their cast neighbours, so larger steps mostly cost more re-cast columns rather than visible errors.
+#define INTERLACE_MAX_MOVE 0.5
+#define INTERLACE_MAX_TURN 0.4
+// relative depth a reprojected wall column may lie outside its cast neighbours' depths
+#define INTERLACE_DEPTH_TOLERANCE 0.02
+// number of frames the visual diff metric is averaged over
+#define INTERLACE_METRIC_FRAMES 60
+
 namespace GameRenderer {
     void init(SDL2pp::Renderer& renderer);
     void destroy();
     void render();
     void resize();
+    // render every other wall column and floor pixel per frame; skipped wall columns are reprojected
+    // from the previous frame, skipped floor pixels are kept from the previous frame while the camera
+    // stands still and copied from their horizontal neighbour otherwise
+    void toggleInterlace();
+    // print the per-channel mean absolute error and PSNR of interlaced against fully rendered frames,
+    // along with the number of frames that fell back to full rendering (slow, for testing)
+    void toggleInterlaceMetric();
 }
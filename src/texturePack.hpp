@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// pre-baked texture pack, written by tools/texpack.cpp and mmapped at startup;
+// pixel data is stored pre-converted to TEXTURE_PACK_FORMAT so no decoding is needed
+#define TEXTURE_PACK_MAGIC "TXPK"
+#define TEXTURE_PACK_VERSION 1
+#define TEXTURE_PACK_FORMAT SDL_PIXELFORMAT_ABGR8888
+#define TEXTURE_PACK_ALIGN 16
+#define TEXTURE_PACK_NAME_LEN 48
+
+typedef struct texture_pack_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+} texture_pack_header;
+
+// the header is followed by `count` entries, offsets are relative to the start of the file
+typedef struct texture_pack_entry {
+    char name[TEXTURE_PACK_NAME_LEN];
+    uint32_t width, height, pitch;
+    uint32_t offset;
+} texture_pack_entry;
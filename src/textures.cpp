@@ -0,0 +1,223 @@
+#include <vector>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <filesystem>
+#include <algorithm>
+#include <unordered_map>
+#include <iostream>
+#include <cstring>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <SDL2/SDL_image.h>
+#include <SDL2pp/Surface.hh>
+#include <SDL2pp/Exception.hh>
+
+#include "textures.hpp"
+#include "texturePack.hpp"
+#include "render.hpp"
+
+namespace Textures {
+    SDL2pp::Renderer* mainRenderer;
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> ids;
+    std::vector<SDL2pp::Texture> textures;
+    std::vector<std::optional<SDL2pp::Surface>> surfaces;
+
+    // magenta/black checkerboard shown while an image is still loading (or failed to load)
+    Uint32 placeholderPixels[TEXTURE_RES * TEXTURE_RES];
+    std::optional<SDL2pp::Surface> placeholder;
+
+    void* packData = MAP_FAILED;
+    size_t packSize = 0;
+    bool loadPack(const char* path);
+    void loadDirectory(const char* path);
+    void addTexture(const std::string& name, std::optional<SDL2pp::Surface> surface);
+
+    // background decoding: workers claim paths by index and hand the results
+    // back through `decoded`, which is only read once `decodedReady` is set
+    std::vector<std::string> paths;
+    std::vector<std::optional<SDL2pp::Surface>> decoded;
+    std::unique_ptr<std::atomic<bool>[]> decodedReady;
+    std::atomic<size_t> nextJob = 0;
+    std::atomic<bool> shall_exit = false;
+    bool loadersRunning = false, imgInitialized = false;
+    pthread_t loaderThreads[TEXTURE_LOADER_THREAD_COUNT];
+    void* loaderWorker(void*) {
+        size_t i;
+        while (!shall_exit && (i = nextJob++) < paths.size()) {
+            try {
+                decoded[i] = SDL2pp::Surface{paths[i]}.Convert(TEXTURE_PACK_FORMAT);
+            } catch (SDL2pp::Exception& e) {
+                std::cerr << "Failed to load " << paths[i] << ": " << e.GetSDLError() << std::endl;
+            }
+            decodedReady[i].store(true, std::memory_order_release);
+        }
+
+        return NULL;
+    }
+
+    void init(SDL2pp::Renderer& renderer) {
+        mainRenderer = &renderer;
+
+        for (int y = 0; y < TEXTURE_RES; y++)
+            for (int x = 0; x < TEXTURE_RES; x++)
+                placeholderPixels[y*TEXTURE_RES + x] = ((x / 8 + y / 8) % 2) ? 0xffff00ff : 0xff000000;
+        placeholder.emplace(placeholderPixels, TEXTURE_RES, TEXTURE_RES, 32, 4*TEXTURE_RES, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+
+        if (!loadPack(TEXTURE_PACK_PATH))
+            loadDirectory(TEXTURE_BASE_PATH);
+    }
+
+    void destroy() {
+        shall_exit = true;
+        if (loadersRunning) {
+            for (int i = 0; i < TEXTURE_LOADER_THREAD_COUNT; i++)
+                pthread_join(loaderThreads[i], NULL);
+            loadersRunning = false;
+        }
+
+        // textures must be freed before their renderer
+        textures.clear();
+        surfaces.clear();
+        decoded.clear();
+
+        if (imgInitialized) {
+            IMG_Quit();
+            imgInitialized = false;
+        }
+
+        if (packData != MAP_FAILED) {
+            munmap(packData, packSize);
+            packData = MAP_FAILED;
+        }
+    }
+
+    // uploads the surface, or the placeholder if there is none (yet)
+    void addTexture(const std::string& name, std::optional<SDL2pp::Surface> surface) {
+        ids[name] = names.size();
+        names.push_back(name);
+        textures.push_back(SDL2pp::Texture{*mainRenderer, surface ? *surface : *placeholder});
+        surfaces.push_back(std::move(surface));
+    }
+
+    bool loadPack(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(texture_pack_header)) {
+            packSize = st.st_size;
+            // private mapping, so that SDL may write to the surfaces without touching the file
+            packData = mmap(NULL, packSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (packData == MAP_FAILED) return false;
+
+        const char* base = (const char*)packData;
+        const texture_pack_header* header = (const texture_pack_header*)base;
+        if (memcmp(header->magic, TEXTURE_PACK_MAGIC, 4) != 0 || header->version != TEXTURE_PACK_VERSION
+            || sizeof(texture_pack_header) + header->count * sizeof(texture_pack_entry) > packSize) {
+            std::cerr << path << " is not a valid texture pack, ignoring it" << std::endl;
+            munmap(packData, packSize);
+            packData = MAP_FAILED;
+            return false;
+        }
+
+        const texture_pack_entry* entries = (const texture_pack_entry*)(base + sizeof(texture_pack_header));
+        for (uint32_t i = 0; i < header->count; i++) {
+            const texture_pack_entry& e = entries[i];
+            const std::string name(e.name, strnlen(e.name, TEXTURE_PACK_NAME_LEN));
+            // the floor pass assumes TEXTURE_RES x TEXTURE_RES textures
+            if (e.width != TEXTURE_RES || e.height != TEXTURE_RES || e.pitch < 4 * e.width) {
+                std::cerr << path << ": texture " << name << " has an unsupported size, skipping it" << std::endl;
+                addTexture(name, std::nullopt);
+                continue;
+            }
+            if ((size_t)e.offset + (size_t)e.pitch * e.height > packSize) {
+                std::cerr << path << ": texture " << name << " exceeds the pack, skipping it" << std::endl;
+                addTexture(name, std::nullopt);
+                continue;
+            }
+
+            addTexture(name, SDL2pp::Surface{(void*)(base + e.offset), (int)e.width, (int)e.height, 32, (int)e.pitch,
+                0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000});
+        }
+
+        std::cout << "Loaded " << header->count << " textures from " << path << std::endl;
+        return true;
+    }
+
+    void loadDirectory(const char* path) {
+        namespace fs = std::filesystem;
+
+        for (const auto& entry : fs::directory_iterator(path))
+            if (entry.is_regular_file())
+                paths.push_back(entry.path().string());
+
+        // keep the ids stable for maps which don't name their textures
+        std::sort(paths.begin(), paths.end());
+
+        for (const auto& p : paths)
+            addTexture(fs::path(p).stem().string(), std::nullopt);
+
+        decoded.resize(paths.size());
+        decodedReady.reset(new std::atomic<bool>[paths.size()]);
+        for (size_t i = 0; i < paths.size(); i++)
+            decodedReady[i] = false;
+
+        // SDL_image would otherwise initialize each format lazily from within the
+        // loader threads, which isn't thread safe
+        const int imgFlags = IMG_Init(TEXTURE_IMG_FORMATS);
+        if ((imgFlags & TEXTURE_IMG_FORMATS) != TEXTURE_IMG_FORMATS)
+            std::cerr << "Failed to initialize SDL_image: " << IMG_GetError() << std::endl;
+        imgInitialized = true;
+
+        pthread_attr_t pta;
+        pthread_attr_init(&pta);
+        for (int i = 0; i < TEXTURE_LOADER_THREAD_COUNT; i++)
+            pthread_create(&loaderThreads[i], &pta, &loaderWorker, NULL);
+        loadersRunning = true;
+    }
+
+    void poll() {
+        if (!loadersRunning) return;
+
+        // failed images stay placeholders, but still count as done
+        size_t done = 0;
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (!decodedReady[i].load(std::memory_order_acquire)) continue;
+            done++;
+            if (!decoded[i]) continue;
+
+            textures[i] = SDL2pp::Texture{*mainRenderer, *decoded[i]};
+            surfaces[i] = std::move(decoded[i]);
+            decoded[i].reset();
+        }
+
+        if (done == paths.size()) {
+            for (int i = 0; i < TEXTURE_LOADER_THREAD_COUNT; i++)
+                pthread_join(loaderThreads[i], NULL);
+            loadersRunning = false;
+            std::cout << "Loaded " << paths.size() << " textures from " << TEXTURE_BASE_PATH << std::endl;
+        }
+    }
+
+    int count() { return names.size(); }
+
+    int find(const std::string& name) {
+        auto it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
+    }
+
+    SDL2pp::Texture& get(int id) { return textures[id]; }
+
+    Uint32* pixels(int id) {
+        return (Uint32*)(surfaces[id] ? surfaces[id] : placeholder)->Get()->pixels;
+    }
+}
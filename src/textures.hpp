@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include <SDL2/SDL.h>
+#include <SDL2pp/Renderer.hh>
+#include <SDL2pp/Texture.hh>
+
+#define TEXTURE_BASE_PATH "./textures"
+#define TEXTURE_PACK_PATH "./textures.pack"
+#ifndef TEXTURE_LOADER_THREAD_COUNT
+#define TEXTURE_LOADER_THREAD_COUNT 4
+#endif
+// image formats SDL_image initializes up front, before the loader threads start
+#define TEXTURE_IMG_FORMATS (IMG_INIT_PNG | IMG_INIT_JPG)
+
+namespace Textures {
+    // loads the texture pack if there is one, otherwise starts decoding the
+    // texture directory in the background; until an image has been decoded,
+    // its texture is replaced with a placeholder
+    void init(SDL2pp::Renderer& renderer);
+    void destroy();
+    // uploads finished images, must be called from the main thread
+    void poll();
+
+    int count();
+    // returns the id of the texture with the given name (file name without extension), or -1
+    int find(const std::string& name);
+    SDL2pp::Texture& get(int id);
+    // pixel data in TEXTURE_PACK_FORMAT
+    Uint32* pixels(int id);
+}
@@ -0,0 +1,92 @@
+// bakes a texture directory into a single pack that the game can mmap at startup
+// usage: texpack [texture directory] [output file]
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#include <SDL2/SDL.h>
+#include <SDL2pp/Surface.hh>
+#include <SDL2pp/Exception.hh>
+
+#include "../src/texturePack.hpp"
+#include "../src/textures.hpp"
+#include "../src/render.hpp"
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    const std::string texBasePath = argc > 1 ? argv[1] : TEXTURE_BASE_PATH,
+                      packPath = argc > 2 ? argv[2] : TEXTURE_PACK_PATH;
+
+    std::vector<std::string> texPaths;
+    for (const auto& entry : fs::directory_iterator(texBasePath))
+        if (entry.is_regular_file())
+            texPaths.push_back(entry.path().string());
+
+    // same order as the game uses when loading the directory
+    std::sort(texPaths.begin(), texPaths.end());
+
+    std::vector<SDL2pp::Surface> surfaces;
+    std::vector<texture_pack_entry> entries;
+    uint32_t offset = sizeof(texture_pack_header) + texPaths.size() * sizeof(texture_pack_entry);
+    for (const auto& path : texPaths) {
+        const std::string name = fs::path(path).stem().string();
+        if (name.size() >= TEXTURE_PACK_NAME_LEN) {
+            std::cerr << "Texture name too long: " << name << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        try {
+            surfaces.push_back(SDL2pp::Surface{path}.Convert(TEXTURE_PACK_FORMAT));
+        } catch (SDL2pp::Exception& e) {
+            std::cerr << "Failed to load " << path << ": " << e.GetSDLError() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // the game's floor pass assumes TEXTURE_RES x TEXTURE_RES textures
+        if (surfaces.back().GetWidth() != TEXTURE_RES || surfaces.back().GetHeight() != TEXTURE_RES) {
+            std::cerr << path << " is not " << TEXTURE_RES << "x" << TEXTURE_RES << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        texture_pack_entry e = {};
+        strncpy(e.name, name.c_str(), TEXTURE_PACK_NAME_LEN - 1);
+        e.width = surfaces.back().GetWidth();
+        e.height = surfaces.back().GetHeight();
+        e.pitch = 4 * e.width;
+        offset = (offset + TEXTURE_PACK_ALIGN - 1) / TEXTURE_PACK_ALIGN * TEXTURE_PACK_ALIGN;
+        e.offset = offset;
+        offset += e.pitch * e.height;
+        entries.push_back(e);
+    }
+
+    std::ofstream out(packPath, std::ios::binary);
+    texture_pack_header header = {};
+    memcpy(header.magic, TEXTURE_PACK_MAGIC, 4);
+    header.version = TEXTURE_PACK_VERSION;
+    header.count = entries.size();
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)entries.data(), entries.size() * sizeof(texture_pack_entry));
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        // pad up to the aligned offset
+        while ((uint32_t)out.tellp() < entries[i].offset)
+            out.put(0);
+
+        // the converted surface may have a padded pitch, so copy line by line
+        const SDL_Surface* surf = surfaces[i].Get();
+        for (uint32_t y = 0; y < entries[i].height; y++)
+            out.write((const char*)surf->pixels + y * surf->pitch, entries[i].pitch);
+    }
+
+    if (!out) {
+        std::cerr << "Failed to write " << packPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Packed " << entries.size() << " textures into " << packPath << std::endl;
+    return EXIT_SUCCESS;
+}